@@ -5,18 +5,27 @@
 		1. <test_image> - images should be located in '\input'-folder\n
 		2. <cl_dist_type> - int, [0; 4], the type of color distance which will be applied by algorithm\n
 		3. <cl_dist_thld> - double, >0, the threshold value for defining the pixels similarity\n
+		4. <out_file> - binary file where the regions found by each click are streamed as spans and contours
+		   (see \ref RegionWriter.h for the format), '-' - don't write; with the file set, the region is found
+		   by the span fill only\n
+		5. <cache_dir> - directory of preprocessed images cache, so the next start doesn't decode and convert
+		   the image again (see \ref ImageCache.h)\n
 	\n
 	Syntacsis: \n
 		findContigReg \n
 		findContigReg <test_image>\n
 		findContigReg <test_image> <cl_dist_type>\n
 		findContigReg <test_image> <cl_dist_type> <cl_dist_thld>\n
+		findContigReg <test_image> <cl_dist_type> <cl_dist_thld> <out_file>\n
+		findContigReg <test_image> <cl_dist_type> <cl_dist_thld> <out_file> <cache_dir>\n
 		\n
 		(for default values see \ref config.h)\n
 	
 	\n
 	Commands:  \n
 		- press LEFT mouse button on the INPUT IMAGE window for choosing the initial pixel;\n
+		- press 'r' for continuing the fill truncated by the budget (see DEFAULT_MAX_PIXELS etc. in \ref config.h);\n
+		  pixels and distance limits are doubled on each resume, time limit applies to each resume;\n
 		- press 'q' for exit the program (should be pressed while the 'Base image' window is active).
 	
 	\details Builded on the Windows 10 x64, openCV version - 3.4.4, CMake and MinGW were used.
@@ -54,6 +63,10 @@ int main(int argc, char* argv[])
 	uint8_t clDistType = DefParams::DEFAULT_CLDIST_TYPE;
 	// Default color distance threshold value
 	double clDistThr = DefParams::DEFAULT_CLDIST_THRD;
+	// Output file for found regions, not used by default
+	string outFName;
+	// Directory of preprocessed images cache
+	string cacheDir(DefParams::DEFAULT_CACHE_DIR);
 	
 	// Check the number of utility input arguments
 	switch (argc){
@@ -79,7 +92,24 @@ int main(int argc, char* argv[])
 			clDistThr = stod(argv[3]);
 			break;
 		}
-		// if (argc > 4)...
+		// All parameters including the Output file are set up
+		case 5: {
+			baseImgFName.assign(argv[1]);
+			clDistType = stoi(argv[2]);
+			clDistThr = stod(argv[3]);
+			outFName.assign(argv[4]);
+			break;
+		}
+		// All parameters including the Cache directory are set up
+		case 6: {
+			baseImgFName.assign(argv[1]);
+			clDistType = stoi(argv[2]);
+			clDistThr = stod(argv[3]);
+			outFName.assign(argv[4]);
+			cacheDir.assign(argv[5]);
+			break;
+		}
+		// if (argc > 6)...
 		default:{
 			cout << " Too many parameters!\n See brief overview for details...\n" << endl;
 			return -1;
@@ -88,10 +118,21 @@ int main(int argc, char* argv[])
 	
 	// Initialize main object with the name of inputed image
 	Visualizer vizObj(baseImgFName);
+	// Set up the cache of preprocessed images
+	vizObj.setCacheDir(cacheDir);
 	// Read the test image
 	vizObj.readBaseImg();
 	// Show the test image in the separate window using openCV-function
 	vizObj.showBaseImg();
+	// Open the output file for streaming the found regions
+	if (!outFName.empty() && outFName != "-" && vizObj.setOutputFile(outFName))
+		return -1;
+	// Set up the limits of the fill
+	FillBudget budget;
+	budget.maxPixels = DefParams::DEFAULT_MAX_PIXELS;
+	budget.maxDist = DefParams::DEFAULT_MAX_DIST;
+	budget.maxTimeMs = DefParams::DEFAULT_MAX_TIME_MS;
+	vizObj.setFillBudget(budget);
 	// Main method for starting the processing of the image by running the mouse callback
 	vizObj.startProcessing(clDistType, clDistThr);
 	// Output of the utility for further processing
@@ -102,8 +143,12 @@ int main(int argc, char* argv[])
 		int c = waitKey(0);
 		if((char)c == 'q') {
 			cout << " Exiting ...\n";
+			// Keep the converted image for the next start
+			vizObj.updateCache();
 			break;
 		}
+		if((char)c == 'r')
+			vizObj.resumeProcessing();
 	}
 	return 0;
 }
@@ -118,8 +163,11 @@ void help() {
 			"           findContigReg <test_image>\n" << 
 			"           findContigReg <test_image> <cl_dist_type>\n" <<
 			"           findContigReg <test_image> <cl_dist_type> <cl_dist_thld>\n" <<
+			"           findContigReg <test_image> <cl_dist_type> <cl_dist_thld> <out_file>\n" <<
+			"           findContigReg <test_image> <cl_dist_type> <cl_dist_thld> <out_file|-> <cache_dir>\n" <<
 			"Commands:  \n"
 			"           press LEFT mouse button on the INPUT IMAGE window for choosing the initial pixel\n" <<
+			"           press 'r' for continuing the region truncated by the fill budget\n" <<
 			"           press 'q' for exit the program (should be pressed while the 'Base image' window is active)" << 
 			std::endl;
 }
@@ -7,6 +7,8 @@
 
 #include <iostream>
 #include <string>
+#include <cmath>
+#include <cstdint>
 #include "../src/Converter.h"
 #include "../src/config.h"
 
@@ -33,12 +35,24 @@ void Converter::setParams(uint8_t _clDistType, double _clDistThr) {
 	clDistType = _clDistType;
 	clDistThr = _clDistThr;
 	switch (clDistType){
-		case 3: {
-			cv::cvtColor(baseImg, baseImg, cv::COLOR_BGR2Lab);
+		case 3:
+		case 4: {
+			// Lab image may be already set, e.g. loaded from the cache; otherwise
+			// tiles are converted lazily by getFillPx() when the fill enters them
+			if (labImg.empty()) {
+				labImg.create(baseImg.size(), CV_8UC3);
+				tilesCols = (baseImg.cols + DefParams::LAB_TILE_SIZE - 1) >> DefParams::LAB_TILE_SHIFT;
+				int tilesRows = (baseImg.rows + DefParams::LAB_TILE_SIZE - 1) >> DefParams::LAB_TILE_SHIFT;
+				tileReady.assign((size_t)tilesRows * tilesCols, 0);
+			}
+			fillImg = labImg;
+			convertTiles = !tileReady.empty();
 			break;
 		}
-		case 4: {
-			cv::cvtColor(baseImg, baseImg, cv::COLOR_BGR2Lab);
+		default: {
+			// Converted tiles are kept for switching back to Lab distances
+			fillImg = baseImg;
+			convertTiles = false;
 			break;
 		}
 	}
@@ -48,10 +62,95 @@ void Converter::setParams(uint8_t _clDistType, double _clDistThr) {
 //! Getter - Returns 'maskImg' content
 void Converter::setBaseImg(const cv::Mat & _baseImg) {	
 	baseImg = _baseImg;
+	labImg.release();
+	chromaImg.release();
+	tileReady.clear();
+	convertTiles = false;
 	maskImg = cv::Mat::zeros(baseImg.size(), CV_8UC1);
 }
 
 
+//! Setter for the precomputed Lab image and its chroma plane
+/*!
+  \param _labImg - base image converted to Lab color space
+  \param _chromaImg - CV_64FC1 chroma of the Lab image (see calcChromaImg()), may be empty
+*/
+void Converter::setLabImg(const cv::Mat & _labImg, const cv::Mat & _chromaImg) {
+	labImg = _labImg;
+	chromaImg = _chromaImg;
+	tileReady.clear();
+	convertTiles = false;
+}
+
+
+//! Converts one tile of the base image to Lab color space
+/*!
+  \param tileRow - row of the tile
+  \param tileCol - column of the tile
+*/
+void Converter::convertTile(int tileRow, int tileCol) {
+	int row = tileRow << DefParams::LAB_TILE_SHIFT;
+	int col = tileCol << DefParams::LAB_TILE_SHIFT;
+	cv::Rect tileRect(col, row, std::min(DefParams::LAB_TILE_SIZE, baseImg.cols - col),
+					  std::min(DefParams::LAB_TILE_SIZE, baseImg.rows - row));
+	// ROI headers refer to the full-size images, so the converted data stays there
+	cv::Mat labTile = labImg(tileRect);
+	cv::cvtColor(baseImg(tileRect), labTile, cv::COLOR_BGR2Lab);
+	tileReady[(size_t)tileRow * tilesCols + tileCol] = 1;
+	// Conversion takes time as the check of every tile pixel
+	checkedN += tileRect.area();
+	if (debug)
+		std::cout << "Tile [row = " << tileRow << "; col = " << tileCol << "] is converted to Lab" << std::endl;
+}
+
+
+//! Returns the whole Lab image; converts the tiles which aren't converted yet
+/*!
+  \param _labImg - output, base image in Lab color space; empty if the distance doesn't use it
+*/
+void Converter::getLabImg(cv::Mat & _labImg) {
+	for (size_t idx = 0; idx < tileReady.size(); idx++)
+		if (!tileReady[idx])
+			convertTile((int)(idx / tilesCols), (int)(idx % tilesCols));
+	_labImg = labImg;
+}
+
+
+//! Returns the pixel of the image compared by the fill; converts its tile first, if necessary
+inline const cv::Vec3b & Converter::getFillPx(int pxRow, int pxCol) {
+	if (convertTiles) {
+		int tileRow = pxRow >> DefParams::LAB_TILE_SHIFT;
+		int tileCol = pxCol >> DefParams::LAB_TILE_SHIFT;
+		if (!tileReady[(size_t)tileRow * tilesCols + tileCol])
+			convertTile(tileRow, tileCol);
+	}
+	return fillImg.at<cv::Vec3b>(pxRow, pxCol);
+}
+
+
+//! Calculates chroma of the Lab pixel, sqrt(a*a + b*b)
+inline double Converter::calcChroma(const cv::Vec3b & px) {
+	return std::exp(0.5 * std::log((double)(px[1] * px[1] + px[2] * px[2])));
+}
+
+
+//! Calculates chroma plane of the Lab image, used by CIE94 distance
+/*!
+	Values are the same as the ones calculated per pixel, so the plane doesn't change the found region.
+  \param labImg - image in Lab color space
+  \param chromaImg - output CV_64FC1 image, sqrt(a*a + b*b) for each pixel
+*/
+void Converter::calcChromaImg(const cv::Mat & labImg, cv::Mat & chromaImg) {
+	chromaImg.create(labImg.size(), CV_64FC1);
+	for (int row = 0; row < labImg.rows; row++) {
+		const cv::Vec3b * labRow = labImg.ptr<cv::Vec3b>(row);
+		double * chromaRow = chromaImg.ptr<double>(row);
+		for (int col = 0; col < labImg.cols; col++)
+			chromaRow[col] = calcChroma(labRow[col]);
+	}
+}
+
+
 //! Getter - Returns 'maskImg' content
 cv::Mat Converter::getMaskImg() {	
 	return maskImg;
@@ -77,7 +176,9 @@ void Converter::showMaskImg() {
 //! Set Pixel point to be processed by main function
 void Converter::setPoint(const cv::Point & _pxPos) {
 	pxPos = _pxPos;
-	pxVal = baseImg.at<cv::Vec3b>(pxPos.y, pxPos.x);
+	pxVal = getFillPx(pxPos.y, pxPos.x);
+	if (!chromaImg.empty())
+		pxChroma = chromaImg.at<double>(pxPos.y, pxPos.x);
 	if (debug)
 		std::cout << "Defined pixel coords: [row = " << pxPos.y << "; col = " << pxPos.x <<
 			"], Pixel Value = " << pxVal << std::endl;
@@ -85,37 +186,70 @@ void Converter::setPoint(const cv::Point & _pxPos) {
 
 
 //! FindRegion function - the main one
-bool Converter::findRegion() {
+/*!
+	\return FILL_TRUNCATED if the fill was stopped by the budget (see setBudget()); it may be
+			continued by resumeRegion()
+*/
+FillStatus Converter::findRegion() {
+	maskFill = FillState();
+	// The first pixel is checked as the deferred one, so it is subject to the budget as well
+	maskFill.deferred.push_back(pxPos);
+	return resumeRegion();
+}
+
+
+//! Continues the fill truncated by findRegion() or by the previous call, with the current budget
+FillStatus Converter::resumeRegion() {
 	using namespace cv;	
 	using namespace std;	
 	
-	// The first pixel is always TRUE and is painted by white color
-	maskImg.at<uchar>(pxPos.y, pxPos.x) = 255;
-	// Queue for storing the pixels to be checked
-	queue<Point> fifo;
-	
 	// Lambda-function for checking the current pixel
-	auto lPxCheck = [&fifo, this](int pxX, int pxY)->bool{
+	auto lPxCheck = [this](int pxX, int pxY)->bool{
 		//if (this->debug)
 			//cout << "lPxCheck:  pxRow = " << pxY << ", pxCol = " << pxX <<  endl; 
 		// Perform checking
-		if (checkPxPos(pxY, pxX) && checkPxMask(pxY, pxX) && checkPxColor(pxY, pxX)) {
-			fifo.push(Point(pxX, pxY));
+		if (!checkPxPos(pxY, pxX) || !checkPxMask(pxY, pxX))
+			return false;
+		// Similar pixels out of the budget are kept for resuming, the rest are rejected for good.
+		// Deferred pixels are marked, so each of them is kept once
+		if (isBudgetOver(maskFill.pixelsN) || isPxOutOfLimits(pxY, pxX)) {
+			if (checkPxSimilar(pxY, pxX)) {
+				maskImg.at<uchar>(pxY, pxX) = 50;
+				maskFill.deferred.push_back(Point(pxX, pxY));
+			}
+			else
+				maskImg.at<uchar>(pxY, pxX) = 100;
+			return false;
+		}
+		if (checkPxColor(pxY, pxX)) {
+			maskFill.pending.push_back(Point(pxX, pxY));
+			maskFill.pixelsN++;
 			return true;
 		}
 		return false;
 	};
-		
-	// Push the initial pixels located on cross with the center in 'pixel'
-	int X = pxPos.x;
-	int Y = pxPos.y-1;
-	lPxCheck(X, Y);
-	X = pxPos.x+1;       Y = pxPos.y;      lPxCheck(X, Y);	
-	X = pxPos.x;         Y = pxPos.y+1;	   lPxCheck(X, Y);
-	X = pxPos.x-1;       Y = pxPos.y;      lPxCheck(X, Y);
 	
-	while (not fifo.empty()) {
-		Point px2Check = fifo.front();		
+	startDeadline();
+	
+	// Re-check the pixels deferred by the previous budget
+	vector<Point> deferred;
+	deferred.swap(maskFill.deferred);
+	for (size_t idx = 0; idx < deferred.size(); idx++) {
+		// Keep the rest of them deferred, if the time is over
+		if (isTimeOver()) {
+			maskFill.deferred.insert(maskFill.deferred.end(), deferred.begin() + idx, deferred.end());
+			break;
+		}
+		maskImg.at<uchar>(deferred[idx].y, deferred[idx].x) = 0;
+		lPxCheck(deferred[idx].x, deferred[idx].y);
+	}
+	
+	int X, Y;
+	while (not maskFill.pending.empty()) {
+		// Four neighbours of the pixel are checked
+		if (isTimeOver(4))
+			break;
+		Point px2Check = maskFill.pending.front();		
 		// Checking the first neighbour pixel
 		X = px2Check.x;   Y = px2Check.y-1;  lPxCheck(X, Y);		
 		// Checking the second neighbour pixel
@@ -125,9 +259,259 @@ bool Converter::findRegion() {
 		// Checking the fourth neighbour pixel
 		X = px2Check.x-1; Y = px2Check.y;    lPxCheck(X, Y);
 		// Remove the checked point
-		fifo.pop();
+		maskFill.pending.pop_front();
+	}
+	maskFill.status = (maskFill.pending.empty() && maskFill.deferred.empty()) ? FILL_COMPLETE : FILL_TRUNCATED;
+	if (debug && maskFill.status == FILL_TRUNCATED)
+		cout << "Region is truncated: " << maskFill.pixelsN << " pixels, " << maskFill.pending.size() <<
+			" pending, " << maskFill.deferred.size() << " deferred" << endl;
+	return maskFill.status;
+}
+
+
+//! Finds the contiguous region as run-length spans, without the mask image
+/*!
+	Scanline fill: every seed is extended to the whole span of similar pixels in its row,
+	then one seed is pushed for every run of similar pixels in the rows above and below.
+	The region itself serves as the "visited" storage, so no image-sized buffer is allocated.
+	\return FILL_TRUNCATED if the fill was stopped by the budget (see setBudget()); it may be
+			continued by resumeRegionSpans()
+*/
+FillStatus Converter::findRegionSpans() {
+	region.reset(baseImg.rows);
+	spanFill = FillState();
+	// The first seed is always similar
+	spanFill.deferred.push_back(pxPos);
+	return resumeRegionSpans();
+}
+
+
+//! Continues the span fill truncated by findRegionSpans() or by the previous call, with the current budget
+FillStatus Converter::resumeRegionSpans() {
+	using namespace cv;
+	using namespace std;
+	
+	startDeadline();
+	// Deferred seeds are similar pixels, so they go to the stack as they are
+	spanFill.pending.insert(spanFill.pending.end(), spanFill.deferred.begin(), spanFill.deferred.end());
+	spanFill.deferred.clear();
+	// Finish the neighbour rows left unscanned by the previous call
+	vector<RegionSpan> rescan;
+	rescan.swap(spanFill.rescan);
+	for (const RegionSpan & part : rescan)
+		scanRowRuns(part.row, part.colBeg, part.colEnd);
+	
+	while (not spanFill.pending.empty()) {
+		if (isTimeOver())
+			break;
+		Point seed = spanFill.pending.back();
+		if (region.contains(seed.y, seed.x)) {
+			spanFill.pending.pop_back();
+			continue;
+		}
+		// Stop leaving the seed in the stack, if the pixels budget is over
+		if (isBudgetOver(region.getPixelsN()))
+			break;
+		spanFill.pending.pop_back();
+		int limBeg, limEnd;
+		getLimitsInRow(seed.y, limBeg, limEnd);
+		if (seed.x < limBeg || seed.x >= limEnd) {
+			spanFill.deferred.push_back(seed);
+			continue;
+		}
+		// Extend the span to the left and to the right within the budget; the pixel where
+		// the extension stopped is deferred, so the resumed fill continues the span from it
+		size_t room = (budget.maxPixels > 0) ? budget.maxPixels - region.getPixelsN() : SIZE_MAX;
+		int colBeg = seed.x;
+		int colEnd = seed.x+1;
+		while (colBeg > 0 && !region.contains(seed.y, colBeg-1) && checkPxSimilar(seed.y, colBeg-1)) {
+			if ((size_t)(colEnd - colBeg) >= room || colBeg-1 < limBeg || isTimeOver()) {
+				spanFill.deferred.push_back(Point(colBeg-1, seed.y));
+				break;
+			}
+			colBeg--;
+		}
+		while (colEnd < baseImg.cols && !region.contains(seed.y, colEnd) && checkPxSimilar(seed.y, colEnd)) {
+			if ((size_t)(colEnd - colBeg) >= room || colEnd >= limEnd || isTimeOver()) {
+				spanFill.deferred.push_back(Point(colEnd, seed.y));
+				break;
+			}
+			colEnd++;
+		}
+		region.addSpan(seed.y, colBeg, colEnd);
+		
+		for (int row : {seed.y-1, seed.y+1})
+			if (row >= 0 && row < baseImg.rows)
+				scanRowRuns(row, colBeg, colEnd);
 	}
-	return 0;
+	spanFill.status = (spanFill.pending.empty() && spanFill.deferred.empty() && spanFill.rescan.empty()) ?
+					  FILL_COMPLETE : FILL_TRUNCATED;
+	if (debug)
+		cout << "Region: " << region.getPixelsN() << " pixels, " << region.getSpansN() << " spans" <<
+			(spanFill.status == FILL_TRUNCATED ? ", truncated" : "") << endl;
+	return spanFill.status;
+}
+
+
+//! Pushes a seed for every run of similar pixels in the part of the row, the span fill only
+/*!
+	A run is split at the limits of the row, so its part within the limits gets its own seed
+	and the part out of them is deferred. If the time is over, the rest of the part is kept
+	for rescanning by the resumed fill.
+  \param pxRow - row to be scanned
+  \param colBeg - first column of the part
+  \param colEnd - column after the last one of the part
+*/
+void Converter::scanRowRuns(int pxRow, int colBeg, int colEnd) {
+	int limBeg, limEnd;
+	getLimitsInRow(pxRow, limBeg, limEnd);
+	bool inRun = false;
+	bool runInLimits = false;
+	for (int col = colBeg; col < colEnd; col++) {
+		// Skip the pixels which are already in region
+		int spanEnd = region.spanEndAt(pxRow, col);
+		if (spanEnd >= 0) {
+			col = spanEnd-1;
+			inRun = false;
+			continue;
+		}
+		if (isTimeOver()) {
+			spanFill.rescan.push_back(RegionSpan{pxRow, col, colEnd});
+			return;
+		}
+		if (checkPxSimilar(pxRow, col)) {
+			bool inLimits = (col >= limBeg && col < limEnd);
+			if (!inRun || inLimits != runInLimits) {
+				if (inLimits)
+					spanFill.pending.push_back(cv::Point(col, pxRow));
+				else
+					spanFill.deferred.push_back(cv::Point(col, pxRow));
+			}
+			inRun = true;
+			runInLimits = inLimits;
+		}
+		else
+			inRun = false;
+	}
+}
+
+
+//! Getter for the region found by span fill
+const Region & Converter::getRegion() const {
+	return region;
+}
+
+
+//! Draws the region found by span fill on the new mask image
+/*!
+	Lets the span fill be shown without running the mask fill; rejected pixels aren't marked.
+*/
+void Converter::drawRegionMask() {
+	maskImg = cv::Mat::zeros(baseImg.size(), CV_8UC1);
+	region.drawOnMask(maskImg, 255);
+}
+
+
+//! Setter for the budget of the fill
+/*!
+  \param _budget - limits of the fill; zero or empty values mean "no limit"
+*/
+void Converter::setBudget(const FillBudget & _budget) {
+	budget = _budget;
+}
+
+
+//! Getter for the status of the last findRegion() or resumeRegion() call
+FillStatus Converter::getFillStatus() const {
+	return maskFill.status;
+}
+
+
+//! Getter for the status of the last findRegionSpans() or resumeRegionSpans() call
+FillStatus Converter::getSpanFillStatus() const {
+	return spanFill.status;
+}
+
+
+//! Start counting the time budget of the fill
+void Converter::startDeadline() {
+	checkedN = 0;
+	nextClockN = DefParams::DEADLINE_CHECK_PERIOD;
+	timeOver = false;
+	if (budget.maxTimeMs > 0)
+		deadlineTicks = cv::getTickCount() + (int64_t)(budget.maxTimeMs * cv::getTickFrequency() / 1000);
+}
+
+
+//! Check whether the time budget is over; the clock is read once per DefParams::DEADLINE_CHECK_PERIOD checked pixels
+/*!
+  \param pixelsN - number of pixels to be checked next
+  \return true if the time is over; once it is, the rest of the call gets true without reading the clock
+*/
+bool Converter::isTimeOver(size_t pixelsN) {
+	if (budget.maxTimeMs <= 0)
+		return false;
+	if (timeOver)
+		return true;
+	checkedN += pixelsN;
+	if (checkedN < nextClockN)
+		return false;
+	nextClockN = checkedN + DefParams::DEADLINE_CHECK_PERIOD;
+	timeOver = cv::getTickCount() > deadlineTicks;
+	return timeOver;
+}
+
+
+//! Check whether the pixels budget is over
+bool Converter::isBudgetOver(size_t pixelsN) {
+	return budget.maxPixels > 0 && pixelsN >= budget.maxPixels;
+}
+
+
+//! Returns the columns [limBeg; limEnd) of the row which are within the ROI and the distance limit
+/*!
+  \param pxRow - row of the image
+  \param limBeg - output, the first column within the limits
+  \param limEnd - output, the column next to the last one within the limits; limBeg >= limEnd if there are none
+*/
+void Converter::getLimitsInRow(int pxRow, int & limBeg, int & limEnd) {
+	limBeg = 0;
+	limEnd = baseImg.cols;
+	if (budget.roi.area() > 0) {
+		if (pxRow < budget.roi.y || pxRow >= budget.roi.y + budget.roi.height) {
+			limEnd = limBeg;
+			return;
+		}
+		limBeg = std::max(limBeg, budget.roi.x);
+		limEnd = std::min(limEnd, budget.roi.x + budget.roi.width);
+	}
+	if (budget.maxDist > 0) {
+		int64_t dY = pxRow - pxPos.y;
+		int64_t rest = (int64_t)budget.maxDist * budget.maxDist - dY*dY;
+		if (rest < 0) {
+			limEnd = limBeg;
+			return;
+		}
+		// Half of the circle chord, rounded down exactly
+		int64_t half = (int64_t)std::sqrt((double)rest);
+		while (half*half > rest) half--;
+		while ((half+1)*(half+1) <= rest) half++;
+		limBeg = (int)std::max<int64_t>(limBeg, pxPos.x - half);
+		limEnd = (int)std::min<int64_t>(limEnd, pxPos.x + half + 1);
+	}
+}
+
+
+//! Check whether the pixel is out of the ROI or too far from the selected one
+bool Converter::isPxOutOfLimits(int pxRow, int pxCol) {
+	if (budget.roi.area() > 0 && !budget.roi.contains(cv::Point(pxCol, pxRow)))
+		return true;
+	if (budget.maxDist > 0) {
+		int64_t dX = pxCol - pxPos.x;
+		int64_t dY = pxRow - pxPos.y;
+		return dX*dX + dY*dY > (int64_t)budget.maxDist * budget.maxDist;
+	}
+	return false;
 }
 
 
@@ -167,11 +551,7 @@ bool Converter::checkPxColor(int pxRow, int pxCol) {
 	using namespace std;
 	using namespace cv;
 	
-	Vec3b newPxVal = baseImg.at<Vec3b>(pxRow, pxCol);
-	
-	//cout << "checkPxColor: newPxVal = " << newPxVal << ", pxVal = " << pxVal << endl;
-	double pxDist = calcPixelDistance(newPxVal, pxVal, clDistType);
-	if (pxDist <= clDistThr) {			
+	if (checkPxSimilar(pxRow, pxCol)) {			
 		maskImg.at<uchar>(pxRow, pxCol) = 255;
 		if (debug) cout << "\t VALUE Check - PASSED" << endl;
 		return true;
@@ -184,6 +564,15 @@ bool Converter::checkPxColor(int pxRow, int pxCol) {
 	return false;
 };
 
+//! Check whether the color of the current pixel is close to the selected one; mask is not used
+bool Converter::checkPxSimilar(int pxRow, int pxCol) {
+	const cv::Vec3b & newPxVal = getFillPx(pxRow, pxCol);
+	// Chroma plane loaded from the cache saves two square roots per pixel for CIE94
+	if (clDistType == 4 && !chromaImg.empty())
+		return calcCIE94Distance(newPxVal, pxVal, chromaImg.at<double>(pxRow, pxCol), pxChroma) <= clDistThr;
+	return calcPixelDistance(newPxVal, pxVal, clDistType) <= clDistThr;
+}
+
 //! Main method which calculates the distance between pixels
 double Converter::calcPixelDistance(const cv::Vec3b & px2Comp, const cv::Vec3b & initPx, uint8_t distType) {
 	using namespace std;
@@ -223,25 +612,7 @@ double Converter::calcPixelDistance(const cv::Vec3b & px2Comp, const cv::Vec3b &
 		}
 		// Advanced Lab distance - CIE 94
 		case 4: {
-			double dL2 = (px2Comp[0] - initPx[0]) * (px2Comp[0] - initPx[0]);
-			double C1_2 = px2Comp[1] * px2Comp[1] + px2Comp[2] * px2Comp[2];
-			double C2_2 = initPx[1] * initPx[1] + initPx[2] * initPx[2];
-			double C1 = exp(0.5 * log(C1_2));
-			double C2 = exp(0.5 * log(C2_2));
-			double dC2 = (C1 - C2) * (C1 - C2);
-			double dA2 = (px2Comp[1] - initPx[1]) * (px2Comp[1] - initPx[1]);
-			double dB2 = (px2Comp[2] - initPx[2]) * (px2Comp[2] - initPx[2]);
-			double dH2 = dA2 + dB2 - dC2;
-			double SC = 1 + DefParams::K1 * C1;
-			double SH = 1 + DefParams::K2 * C1;
-			if ((DefParams::k_L - 1 < 1e-5) && (DefParams::SL - 1 < 1e-5))
-				dist = dL2 + dC2/(SC*SC) + dH2/(SH*SH);
-			else if (DefParams::k_L - 1 < 1e-5)
-				dist = dL2/(DefParams::SL*DefParams::SL) + dC2/(SC*SC) + dH2/(SH*SH);
-			else if (DefParams::SL - 1 < 1e-5)
-				dist = dL2/(DefParams::k_L*DefParams::k_L) + dC2/(SC*SC) + dH2/(SH*SH);
-			else
-				dist = dL2/(DefParams::k_L*DefParams::k_L)/(DefParams::SL*DefParams::SL) + dC2/(SC*SC) + dH2/(SH*SH);
+			dist = calcCIE94Distance(px2Comp, initPx, calcChroma(px2Comp), calcChroma(initPx));
 			break;
 		}
 	}
@@ -250,11 +621,27 @@ double Converter::calcPixelDistance(const cv::Vec3b & px2Comp, const cv::Vec3b &
 }
 
 
-
-
-
-
-
-
-
-
+//! Calculates CIE94 distance between pixels using their chroma values
+/*!
+  \param px2Comp - Lab value of the pixel to be compared
+  \param initPx - Lab value of the pixel selected by user
+  \param C1 - chroma of 'px2Comp'
+  \param C2 - chroma of 'initPx'
+*/
+double Converter::calcCIE94Distance(const cv::Vec3b & px2Comp, const cv::Vec3b & initPx, double C1, double C2) {
+	double dL2 = (px2Comp[0] - initPx[0]) * (px2Comp[0] - initPx[0]);
+	double dC2 = (C1 - C2) * (C1 - C2);
+	double dA2 = (px2Comp[1] - initPx[1]) * (px2Comp[1] - initPx[1]);
+	double dB2 = (px2Comp[2] - initPx[2]) * (px2Comp[2] - initPx[2]);
+	double dH2 = dA2 + dB2 - dC2;
+	double SC = 1 + DefParams::K1 * C1;
+	double SH = 1 + DefParams::K2 * C1;
+	if ((DefParams::k_L - 1 < 1e-5) && (DefParams::SL - 1 < 1e-5))
+		return dL2 + dC2/(SC*SC) + dH2/(SH*SH);
+	else if (DefParams::k_L - 1 < 1e-5)
+		return dL2/(DefParams::SL*DefParams::SL) + dC2/(SC*SC) + dH2/(SH*SH);
+	else if (DefParams::SL - 1 < 1e-5)
+		return dL2/(DefParams::k_L*DefParams::k_L) + dC2/(SC*SC) + dH2/(SH*SH);
+	else
+		return dL2/(DefParams::k_L*DefParams::k_L)/(DefParams::SL*DefParams::SL) + dC2/(SC*SC) + dH2/(SH*SH);
+}
@@ -1,11 +1,55 @@
 #pragma once
 
 #include <string>
-#include <queue>
+#include <deque>
+#include <vector>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/opencv.hpp>
 #include "../src/config.h"
+#include "../src/Region.h"
+
+//! Status of the fill
+enum FillStatus {
+	//! The whole contiguous region is found
+	FILL_COMPLETE = 0,
+	//! The fill was stopped by the budget before it finished, the region may be partial
+	FILL_TRUNCATED
+};
+
+
+//! Limits of the fill, for the predictable latency; zero or empty values mean "no limit"
+/*!
+	Pixels, distance and ROI limits apply to the whole region, across resumes: to continue the fill
+	truncated by them, set the bigger budget by Converter::setBudget() before resuming.
+	Time limit applies to each call separately, so resuming with the same budget continues the fill.
+*/
+struct FillBudget {
+	//! Maximum number of pixels in the whole region
+	size_t maxPixels = 0;
+	//! Maximum Euclidean distance from the selected pixel, pixels
+	int maxDist = 0;
+	//! Region of interest, the fill doesn't leave it
+	cv::Rect roi;
+	//! Wall-clock time limit of one findRegion()/resumeRegion() call, milliseconds
+	double maxTimeMs = 0;
+};
+
+
+//! State of the fill, kept for resuming the truncated one
+struct FillState {
+	//! Pixels to be processed: queue of pixels to expand for the mask fill, stack of seeds for the span fill
+	std::deque<cv::Point> pending;
+	//! Similar pixels which were out of the budget; they are checked again on resume
+	std::vector<cv::Point> deferred;
+	//! Parts of the neighbour rows which the span fill didn't scan because the time was over
+	std::vector<RegionSpan> rescan;
+	//! Number of pixels found by the mask fill
+	size_t pixelsN = 0;
+	//! Status of the last fill call
+	FillStatus status = FILL_COMPLETE;
+};
+
 
 /*! \headerfile Converter.h "/src/Converter.h"
     \brief Header of class Converter
@@ -17,18 +61,48 @@ class Converter {
 	private:
 		//! Private variable, contains input test image
 		cv::Mat baseImg;
+		//! Private variable, contains input test image in Lab color space, used by distances 3 and 4
+		cv::Mat labImg;
+		//! Private variable, contains chroma plane of 'labImg', if it is loaded from the cache; otherwise chroma is calculated per pixel
+		cv::Mat chromaImg;
+		//! Private variable, contains the image which pixels are compared by the fill, 'baseImg' or 'labImg'
+		cv::Mat fillImg;
+		//! Private variable, contains flags of the 'labImg' tiles which are already converted; empty if all of them are
+		std::vector<uint8_t> tileReady;
+		//! Private variable, contains number of tile columns
+		int tilesCols = 0;
+		//! Private variable, whether the fill compares 'labImg' which tiles are converted lazily
+		bool convertTiles = false;
 		//! Private variable, contains obtained mask image
 		cv::Mat maskImg;
 		//! Private variable, contains position of pixel selected by user
 		cv::Point pxPos;
 		//! Private variable, contains the color values of pixel selected by user
 		cv::Vec3b pxVal;
+		//! Private variable, contains the chroma of pixel selected by user, if chroma plane is set
+		double pxChroma = 0;
 		//! Private variable, whether output debug info or not
 		bool debug = DefParams::DEBUG;
 		//! Private variable, contains inputed type of the color distance to be applied
 		uint8_t clDistType;
 		//! Private variable, contains inputed threshold value of the chosen color distance
 		double clDistThr;
+		//! Private variable, contains region obtained by span fill as run-length spans
+		Region region;
+		//! Private variable, contains limits of the fill
+		FillBudget budget;
+		//! Private variable, contains the tick count when the time budget is over
+		int64_t deadlineTicks = 0;
+		//! Private variable, contains number of pixels checked since the deadline was started
+		size_t checkedN = 0;
+		//! Private variable, contains value of 'checkedN' when the clock is read next time
+		size_t nextClockN = 0;
+		//! Private variable, whether the time budget is over
+		bool timeOver = false;
+		//! Private variable, contains state of the mask fill
+		FillState maskFill;
+		//! Private variable, contains state of the span fill
+		FillState spanFill;
 		
 		//! Check the position of the pixel at hand; whether it is inside of image borders or not
 		bool checkPxPos(int pxRow, int pxCol);
@@ -36,8 +110,30 @@ class Converter {
 		bool checkPxMask(int pxRow, int pxCol);
 		//! Check the color value of the current pixel
 		bool checkPxColor(int pxRow, int pxCol);
+		//! Check whether the pixels budget is over
+		bool isBudgetOver(size_t pixelsN);
+		//! Check whether the pixel is out of the ROI or too far from the selected one
+		bool isPxOutOfLimits(int pxRow, int pxCol);
+		//! Returns the columns [limBeg; limEnd) of the row which are within the ROI and the distance limit
+		void getLimitsInRow(int pxRow, int & limBeg, int & limEnd);
+		//! Start counting the time budget of the fill
+		void startDeadline();
+		//! Check whether the time budget is over; the clock is read once per DefParams::DEADLINE_CHECK_PERIOD checked pixels
+		bool isTimeOver(size_t pixelsN = 1);
+		//! Pushes a seed for every run of similar pixels in the part of the row, the span fill only
+		void scanRowRuns(int pxRow, int colBeg, int colEnd);
+		//! Converts one tile of the base image to Lab color space
+		void convertTile(int tileRow, int tileCol);
+		//! Returns the pixel of the image compared by the fill; converts its tile first, if necessary
+		const cv::Vec3b & getFillPx(int pxRow, int pxCol);
+		//! Check whether the color of the current pixel is close to the selected one; mask is not used
+		bool checkPxSimilar(int pxRow, int pxCol);
 		//! Main method which calculates the distance between pixels
 		double calcPixelDistance(const cv::Vec3b & px2Comp, const cv::Vec3b & initPx, uint8_t distType);
+		//! Calculates chroma of the Lab pixel
+		static double calcChroma(const cv::Vec3b & px);
+		//! Calculates CIE94 distance between pixels using their chroma values
+		double calcCIE94Distance(const cv::Vec3b & px2Comp, const cv::Vec3b & initPx, double C1, double C2);
 		
 	
 	public:
@@ -56,6 +152,15 @@ class Converter {
 		//! Setter for base Image
 		void setBaseImg(const cv::Mat &);
 		
+		//! Setter for the precomputed Lab image and its chroma plane; should be called after setBaseImg()
+		void setLabImg(const cv::Mat &, const cv::Mat &);
+		
+		//! Returns the whole Lab image; converts the tiles which aren't converted yet
+		void getLabImg(cv::Mat &);
+		
+		//! Calculates chroma plane of the Lab image, used by CIE94 distance
+		static void calcChromaImg(const cv::Mat &, cv::Mat &);
+		
 		//! Getter - Returns 'maskImg' content
 		cv::Mat getMaskImg();
 		
@@ -68,8 +173,32 @@ class Converter {
 		//! Set Pixel point to be processed by main function
 		void setPoint(const cv::Point &);
 				
+		//! Setter for the budget of the fill
+		void setBudget(const FillBudget &);
+		
 		//! Main function for finding the contiguous region
-		bool findRegion();
+		FillStatus findRegion();
+		
+		//! Continues the fill truncated by findRegion() or by the previous call, with the current budget
+		FillStatus resumeRegion();
+		
+		//! Getter for the status of the last findRegion() or resumeRegion() call
+		FillStatus getFillStatus() const;
+		
+		//! Finds the contiguous region as run-length spans, without the mask image
+		FillStatus findRegionSpans();
+		
+		//! Continues the span fill truncated by findRegionSpans() or by the previous call, with the current budget
+		FillStatus resumeRegionSpans();
+		
+		//! Getter for the status of the last findRegionSpans() or resumeRegionSpans() call
+		FillStatus getSpanFillStatus() const;
+		
+		//! Getter for the region found by span fill
+		const Region & getRegion() const;
+		
+		//! Draws the region found by span fill on the new mask image
+		void drawRegionMask();
 		
 };
 
@@ -0,0 +1,349 @@
+/*! \file ImageCache.cpp
+	\class ImageCache ImageCache.cpp "/src/ImageCache.cpp"
+    \brief Class keeps preprocessed images in the cache directory and maps them read-only into memory.
+
+    Cache entry is considered stale if the size of the source file differs from the stored one,
+	or if its modification time differs and the hash of its content differs as well.
+	Mapped planes are used directly by the fill, so the warm start doesn't copy the pixel data.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <sys/stat.h>
+#ifdef _WIN32
+	#include <direct.h>
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+#include "../src/ImageCache.h"
+
+
+constexpr uint32_t ImageCache::FORMAT_VERSION;
+constexpr uint64_t ImageCache::ALIGNMENT;
+
+
+namespace {
+
+	//! Header of the cache entry
+	struct CacheHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t srcSize;
+		int64_t srcMTime;
+		uint64_t srcHash;
+		int32_t rows;
+		int32_t cols;
+		uint64_t planeOffset[ImageCache::PLANES_N];
+		uint64_t fileSize;
+	};
+
+	//! Types of the planes stored in the cache entry
+	const int PLANE_TYPES[ImageCache::PLANES_N] = {CV_8UC3, CV_8UC3, CV_64FC1};
+
+	//! Round the value up to the planes alignment
+	uint64_t alignUp(uint64_t val) {
+		return (val + ImageCache::ALIGNMENT - 1) / ImageCache::ALIGNMENT * ImageCache::ALIGNMENT;
+	}
+
+	//! FNV-1a hash of the data block, continues from 'hash'
+	uint64_t fnv1a(const char * data, size_t len, uint64_t hash = 14695981039346656037ULL) {
+		for (size_t i = 0; i < len; i++) {
+			hash ^= (unsigned char)data[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	//! FNV-1a hash of the file content
+	uint64_t hashFile(const std::string & fName) {
+		std::ifstream in(fName, std::ios::binary);
+		std::vector<char> buf(1 << 16);
+		uint64_t hash = fnv1a(nullptr, 0);
+		while (in) {
+			in.read(buf.data(), buf.size());
+			hash = fnv1a(buf.data(), (size_t)in.gcount(), hash);
+		}
+		return hash;
+	}
+
+	//! Get size and modification time of the file, nanoseconds where the platform provides them
+	bool getFileStat(const std::string & fName, uint64_t & size, int64_t & mTime) {
+		struct stat st;
+		if (stat(fName.c_str(), &st) != 0)
+			return -1;
+		size = (uint64_t)st.st_size;
+#if defined(__APPLE__)
+		mTime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+		mTime = (int64_t)st.st_mtime * 1000000000;
+#else
+		mTime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+		return 0;
+	}
+}
+
+
+//! Main constructor
+/*!
+  \param _cacheDir - path to the cache directory
+*/
+ImageCache::ImageCache(const std::string & _cacheDir) {
+	setCacheDir(_cacheDir);
+}
+
+
+//! Destructor, unmaps the cache entry
+ImageCache::~ImageCache() {
+	unmap();
+}
+
+
+//! Setter for the cache directory; creates it if necessary
+void ImageCache::setCacheDir(const std::string & _cacheDir) {
+	cacheDir = _cacheDir;
+	if (cacheDir.empty())
+		return;
+	if (cacheDir.back() != '/' && cacheDir.back() != '\\')
+		cacheDir += '/';
+#ifdef _WIN32
+	_mkdir(cacheDir.c_str());
+#else
+	mkdir(cacheDir.c_str(), 0755);
+#endif
+}
+
+
+//! Check whether the cache is enabled
+bool ImageCache::isEnabled() const {
+	return !cacheDir.empty();
+}
+
+
+//! Returns the name of the cache entry for the source image
+/*!
+	Name consists of the source file name and the hash of its full path, so the images
+	with the same names from different folders don't collide.
+*/
+std::string ImageCache::getEntryFName(const std::string & srcFName) const {
+	size_t pos = srcFName.find_last_of("/\\");
+	std::string baseName = (pos == std::string::npos) ? srcFName : srcFName.substr(pos+1);
+	char hashStr[17];
+	std::snprintf(hashStr, sizeof(hashStr), "%016llx",
+				  (unsigned long long)fnv1a(srcFName.data(), srcFName.size()));
+	return cacheDir + baseName + "." + hashStr + ".fcrc";
+}
+
+
+//! Unmap the currently mapped cache entry
+void ImageCache::unmap() {
+	if (mapAddr == nullptr)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(mapAddr);
+	CloseHandle((HANDLE)mapHandle);
+	mapHandle = nullptr;
+#else
+	munmap(mapAddr, mapSize);
+#endif
+	mapAddr = nullptr;
+	mapSize = 0;
+	mapFName.clear();
+}
+
+
+//! Map the cache entry of the source image, if it is present and not stale
+/*!
+  \param srcFName - name of the source image file
+  \param bgrImg - output, source image in BGR color space
+  \param labImg - output, source image in Lab color space, empty if absent
+  \param chromaImg - output, CV_64FC1 chroma plane of Lab image, empty if absent
+  \return 0 if the entry was mapped. Images refer to the read-only mapped memory, which stays valid
+		  until the next load() call or the object destruction
+*/
+bool ImageCache::load(const std::string & srcFName, cv::Mat & bgrImg, cv::Mat & labImg, cv::Mat & chromaImg) {
+	using namespace std;
+
+	if (!isEnabled())
+		return -1;
+	uint64_t srcSize;
+	int64_t srcMTime;
+	if (getFileStat(srcFName, srcSize, srcMTime))
+		return -1;
+
+	unmap();
+	string entryFName = getEntryFName(srcFName);
+#ifdef _WIN32
+	// Mapped entry keeps the sharing mode of this handle, so it allows the mtime update below
+	HANDLE file = CreateFileA(entryFName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return -1;
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	HANDLE handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (handle == NULL)
+		return -1;
+	mapAddr = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+	if (mapAddr == nullptr) {
+		CloseHandle(handle);
+		return -1;
+	}
+	mapHandle = handle;
+	mapSize = (size_t)fileSize.QuadPart;
+#else
+	int fd = open(entryFName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return -1;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CacheHeader)) {
+		close(fd);
+		return -1;
+	}
+	void * addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		return -1;
+	mapAddr = addr;
+	mapSize = (size_t)st.st_size;
+#endif
+	mapFName = entryFName;
+
+	// Validate the header
+	const char * base = (const char *)mapAddr;
+	CacheHeader hdr;
+	bool valid = mapSize >= sizeof(CacheHeader);
+	if (valid) {
+		memcpy(&hdr, base, sizeof(CacheHeader));
+		valid = memcmp(hdr.magic, "FCRC", 4) == 0 && hdr.version == FORMAT_VERSION &&
+				hdr.fileSize == mapSize && hdr.rows > 0 && hdr.cols > 0 && hdr.planeOffset[BGR] != 0;
+	}
+	for (int p = 0; valid && p < PLANES_N; p++) {
+		uint64_t planeSize = (uint64_t)hdr.rows * hdr.cols * CV_ELEM_SIZE(PLANE_TYPES[p]);
+		if (hdr.planeOffset[p] != 0)
+			valid = hdr.planeOffset[p] % ALIGNMENT == 0 && hdr.planeOffset[p] + planeSize <= mapSize;
+	}
+	if (!valid) {
+		cout << " Cache entry \"" << entryFName << "\" is corrupted" << endl;
+		unmap();
+		return -1;
+	}
+
+	// Check whether the source image was changed; the hash is calculated only if the time differs
+	if (hdr.srcSize != srcSize ||
+		(hdr.srcMTime != srcMTime && hdr.srcHash != hashFile(srcFName))) {
+		cout << " Cache entry \"" << entryFName << "\" is stale" << endl;
+		unmap();
+		return -1;
+	}
+	// Content is the same, but the time differs (e.g. after 'touch' or checkout):
+	// remember the new time, so the next start doesn't hash the source again
+	if (hdr.srcMTime != srcMTime) {
+		fstream entry(entryFName, ios::binary | ios::in | ios::out);
+		entry.seekp(offsetof(CacheHeader, srcMTime));
+		entry.write((const char *)&srcMTime, sizeof(srcMTime));
+	}
+
+	// Wrap the mapped planes without copying
+	cv::Mat * planes[PLANES_N] = {&bgrImg, &labImg, &chromaImg};
+	for (int p = 0; p < PLANES_N; p++) {
+		if (hdr.planeOffset[p] != 0)
+			*planes[p] = cv::Mat(hdr.rows, hdr.cols, PLANE_TYPES[p], (void *)(base + hdr.planeOffset[p]));
+		else
+			planes[p]->release();
+	}
+	return 0;
+}
+
+
+//! Write the cache entry of the source image
+/*!
+  \param srcFName - name of the source image file
+  \param bgrImg - source image in BGR color space
+  \param labImg - source image in Lab color space, may be empty
+  \param chromaImg - CV_64FC1 chroma plane of Lab image, may be empty
+  \return 0 if the entry was written. On Windows the mapped file can't be replaced, so if the entry
+		  of this source is mapped, it is unmapped and the images returned by load() become invalid
+*/
+bool ImageCache::store(const std::string & srcFName, const cv::Mat & bgrImg,
+					   const cv::Mat & labImg, const cv::Mat & chromaImg) {
+	using namespace std;
+
+	if (!isEnabled() || bgrImg.empty())
+		return -1;
+	CacheHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, "FCRC", 4);
+	hdr.version = FORMAT_VERSION;
+	if (getFileStat(srcFName, hdr.srcSize, hdr.srcMTime))
+		return -1;
+	hdr.srcHash = hashFile(srcFName);
+	hdr.rows = bgrImg.rows;
+	hdr.cols = bgrImg.cols;
+
+	// Place the planes
+	const cv::Mat * planes[PLANES_N] = {&bgrImg, &labImg, &chromaImg};
+	uint64_t offset = alignUp(sizeof(CacheHeader));
+	for (int p = 0; p < PLANES_N; p++) {
+		if (planes[p]->empty())
+			continue;
+		if (planes[p]->size() != bgrImg.size() || planes[p]->type() != PLANE_TYPES[p]) {
+			cout << " Couldn't cache the image: wrong plane " << p << endl;
+			return -1;
+		}
+		hdr.planeOffset[p] = offset;
+		offset = alignUp(offset + (uint64_t)bgrImg.rows * bgrImg.cols * CV_ELEM_SIZE(PLANE_TYPES[p]));
+	}
+	hdr.fileSize = offset;
+
+	// Write to the temporary file first, so the concurrent reader never maps the partial entry
+	string entryFName = getEntryFName(srcFName);
+	string tmpFName = entryFName + ".tmp";
+	{
+		ofstream out(tmpFName, ios::binary | ios::trunc);
+		if (!out.is_open()) {
+			cout << " Couldn't create the cache entry \"" << tmpFName << "\"" << endl;
+			return -1;
+		}
+		const char zeros[ALIGNMENT] = {};
+		out.write((const char *)&hdr, sizeof(hdr));
+		uint64_t pos = sizeof(hdr);
+		for (int p = 0; p < PLANES_N; p++) {
+			if (hdr.planeOffset[p] == 0)
+				continue;
+			out.write(zeros, (streamsize)(hdr.planeOffset[p] - pos));
+			size_t rowSize = planes[p]->cols * planes[p]->elemSize();
+			for (int row = 0; row < planes[p]->rows; row++)
+				out.write((const char *)planes[p]->ptr(row), rowSize);
+			pos = hdr.planeOffset[p] + rowSize * planes[p]->rows;
+		}
+		out.write(zeros, (streamsize)(hdr.fileSize - pos));
+		if (!out.good()) {
+			cout << " Couldn't write the cache entry \"" << tmpFName << "\"" << endl;
+			out.close();
+			remove(tmpFName.c_str());
+			return -1;
+		}
+	}
+#ifdef _WIN32
+	if (entryFName == mapFName)
+		unmap();
+	bool moved = MoveFileExA(tmpFName.c_str(), entryFName.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool moved = rename(tmpFName.c_str(), entryFName.c_str()) == 0;
+#endif
+	if (!moved) {
+		cout << " Couldn't replace the cache entry \"" << entryFName << "\"" << endl;
+		remove(tmpFName.c_str());
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <opencv2/core/core.hpp>
+
+/*! \headerfile ImageCache.h "/src/ImageCache.h"
+    \brief Header of class ImageCache
+
+    Class keeps preprocessed images (BGR, Lab and optional double chroma plane) in the cache directory
+	and maps them read-only into memory, so the restarted utility doesn't decode and convert them again.\n
+	Cache entry format (native byte order, the cache is local to the machine):\n
+		header - magic "FCRC", uint32 format version, uint64 source size, int64 source mtime in nanoseconds,
+		uint64 source FNV-1a hash, int32 rows, int32 cols, uint64 offsets of BGR, Lab and chroma planes
+		(0 if plane is absent), uint64 entry file size;\n
+		planes - continuous pixel data, each plane starts at the offset aligned to ImageCache::ALIGNMENT bytes.
+*/
+class ImageCache {
+
+	private:
+		//! Private variable, contains path to the cache directory; empty if cache is disabled
+		std::string cacheDir;
+		//! Private variable, contains address of the mapped cache entry
+		void * mapAddr = nullptr;
+		//! Private variable, contains size of the mapped cache entry
+		size_t mapSize = 0;
+		//! Private variable, contains file name of the mapped cache entry
+		std::string mapFName;
+#ifdef _WIN32
+		//! Private variable, contains handle of the file mapping object
+		void * mapHandle = nullptr;
+#endif
+
+		//! Returns the name of the cache entry for the source image
+		std::string getEntryFName(const std::string &) const;
+		//! Unmap the currently mapped cache entry
+		void unmap();
+
+	public:
+		//! Planes stored in the cache entry
+		enum Planes {
+			BGR = 0,
+			LAB,
+			CHROMA,
+			PLANES_N
+		};
+
+		//! Version of the cache entry format
+		static constexpr uint32_t FORMAT_VERSION = 3;
+		//! Alignment of the planes in the cache entry, bytes
+		static constexpr uint64_t ALIGNMENT = 64;
+
+		//! Default constructor, cache is disabled
+		ImageCache() = default;
+
+		//! Main constructor
+		ImageCache(const std::string &);
+
+		//! Destructor, unmaps the cache entry
+		~ImageCache();
+
+		ImageCache(const ImageCache &) = delete;
+		ImageCache & operator=(const ImageCache &) = delete;
+
+		//! Setter for the cache directory; creates it if necessary
+		void setCacheDir(const std::string &);
+
+		//! Check whether the cache is enabled
+		bool isEnabled() const;
+
+		//! Map the cache entry of the source image, if it is present and not stale
+		bool load(const std::string &, cv::Mat &, cv::Mat &, cv::Mat &);
+
+		//! Write the cache entry of the source image
+		bool store(const std::string &, const cv::Mat &, const cv::Mat &, const cv::Mat &);
+
+};
@@ -0,0 +1,244 @@
+/*! \file Region.cpp
+	\class Region Region.cpp "/src/Region.cpp"
+    \brief Class stores the contiguous region as sorted row run-length spans and builds its contour polygons.
+
+    Region is filled span by span directly by the fill algorithm, so the memory used depends on
+    the region complexity, not on the image size. Contours are built from the spans as well.
+*/
+
+#include <algorithm>
+#include "../src/Region.h"
+
+
+//! Reset the region to empty state for the image with given number of rows
+/*!
+  \param rowsN - number of rows of the processed image
+*/
+void Region::reset(int rowsN) {
+	rowSpans.assign(rowsN, std::vector<RegionSpan>());
+	spansN = 0;
+	pixelsN = 0;
+}
+
+
+//! Add span [colBeg; colEnd) to the row; merges it with adjacent spans
+/*!
+  \param row - row of the span
+  \param colBeg - first column of the span
+  \param colEnd - column next to the last one of the span
+*/
+void Region::addSpan(int row, int colBeg, int colEnd) {
+	std::vector<RegionSpan> & spans = rowSpans[row];
+	// Find the first span which starts after the new one
+	auto it = std::upper_bound(spans.begin(), spans.end(), colBeg,
+		[](int col, const RegionSpan & span){ return col < span.colBeg; });
+	// Merge with the previous span if they touch
+	if (it != spans.begin() && (it-1)->colEnd >= colBeg) {
+		--it;
+		colBeg = it->colBeg;
+	}
+	// Merge with all the next spans which touch the new one
+	auto itEnd = it;
+	while (itEnd != spans.end() && itEnd->colBeg <= colEnd) {
+		colEnd = std::max(colEnd, itEnd->colEnd);
+		pixelsN -= itEnd->colEnd - itEnd->colBeg;
+		--spansN;
+		++itEnd;
+	}
+	it = spans.erase(it, itEnd);
+	spans.insert(it, RegionSpan{row, colBeg, colEnd});
+	pixelsN += colEnd - colBeg;
+	++spansN;
+}
+
+
+//! Returns the end of the span covering the pixel, or -1 if the pixel is not in region
+int Region::spanEndAt(int row, int col) const {
+	const std::vector<RegionSpan> & spans = rowSpans[row];
+	auto it = std::upper_bound(spans.begin(), spans.end(), col,
+		[](int c, const RegionSpan & span){ return c < span.colBeg; });
+	if (it != spans.begin() && (it-1)->colEnd > col)
+		return (it-1)->colEnd;
+	return -1;
+}
+
+
+//! Check whether the pixel belongs to the region
+bool Region::contains(int row, int col) const {
+	return spanEndAt(row, col) >= 0;
+}
+
+
+//! Getter for the number of spans
+size_t Region::getSpansN() const {
+	return spansN;
+}
+
+
+//! Getter for the number of pixels
+size_t Region::getPixelsN() const {
+	return pixelsN;
+}
+
+
+//! Returns all spans sorted by row and then by column
+std::vector<RegionSpan> Region::getSpans() const {
+	std::vector<RegionSpan> spans;
+	spans.reserve(spansN);
+	for (const std::vector<RegionSpan> & row : rowSpans)
+		spans.insert(spans.end(), row.begin(), row.end());
+	return spans;
+}
+
+
+//! Returns the contours of the region: outer one first, then the inner ones (holes)
+/*!
+	Contours go along the pixel borders, so vertex (x, y) is the top-left corner of pixel (x, y).
+	The outer contour is clockwise on the screen, holes are counter-clockwise.
+	Diagonally touching pixels are separated, as the fill uses 4-connectivity.
+*/
+std::vector<std::vector<cv::Point>> Region::getContours() const {
+	using namespace std;
+	using namespace cv;
+
+	struct Edge { Point from, to; };
+	vector<Edge> edges;
+
+	// Lambda-function for getting the parts of 'a' spans which are not covered by 'b' spans
+	auto lSpansDiff = [](const vector<RegionSpan> & a, const vector<RegionSpan> & b,
+						 vector<pair<int, int>> & diff) {
+		diff.clear();
+		size_t j = 0;
+		for (const RegionSpan & span : a) {
+			int col = span.colBeg;
+			while (j < b.size() && b[j].colEnd <= col) ++j;
+			size_t k = j;
+			while (col < span.colEnd) {
+				if (k == b.size() || b[k].colBeg >= span.colEnd) {
+					diff.emplace_back(col, span.colEnd);
+					break;
+				}
+				if (b[k].colBeg > col)
+					diff.emplace_back(col, b[k].colBeg);
+				col = max(col, b[k].colEnd);
+				++k;
+			}
+		}
+	};
+
+	// Collect the borders of each span, so that the region is always on the right side of the edge
+	const vector<RegionSpan> noSpans;
+	vector<pair<int, int>> diff;
+	int rowsN = (int)rowSpans.size();
+	for (int y = 0; y < rowsN; y++) {
+		const vector<RegionSpan> & cur = rowSpans[y];
+		if (cur.empty()) continue;
+		const vector<RegionSpan> & above = (y > 0) ? rowSpans[y-1] : noSpans;
+		const vector<RegionSpan> & below = (y < rowsN-1) ? rowSpans[y+1] : noSpans;
+		// Top borders, left to right
+		lSpansDiff(cur, above, diff);
+		for (const pair<int, int> & d : diff)
+			edges.push_back(Edge{Point(d.first, y), Point(d.second, y)});
+		// Bottom borders, right to left
+		lSpansDiff(cur, below, diff);
+		for (const pair<int, int> & d : diff)
+			edges.push_back(Edge{Point(d.second, y+1), Point(d.first, y+1)});
+		// Left borders go up, right borders go down
+		for (const RegionSpan & span : cur) {
+			edges.push_back(Edge{Point(span.colBeg, y+1), Point(span.colBeg, y)});
+			edges.push_back(Edge{Point(span.colEnd, y), Point(span.colEnd, y+1)});
+		}
+	}
+
+	// Sort edges by their start vertex for the fast search of the next edge
+	auto lPtLess = [](const Point & a, const Point & b) {
+		return (a.y < b.y) || (a.y == b.y && a.x < b.x);
+	};
+	sort(edges.begin(), edges.end(), [&lPtLess](const Edge & a, const Edge & b){
+		return lPtLess(a.from, b.from);
+	});
+
+	// Lambda-function for choosing the edge following 'cur'; at the vertex where two region
+	// pixels touch diagonally the right turn is preferred, so that those pixels stay separated
+	auto lNextEdge = [&](size_t cur)->size_t {
+		const Point & v = edges[cur].to;
+		auto it = lower_bound(edges.begin(), edges.end(), v, [&lPtLess](const Edge & e, const Point & p){
+			return lPtLess(e.from, p);
+		});
+		size_t next = it - edges.begin();
+		if (next+1 < edges.size() && edges[next+1].from == v) {
+			Point dir = edges[cur].to - edges[cur].from;
+			Point alt = edges[next+1].to - edges[next+1].from;
+			// Right turn in image coordinates (Y axis goes down): sign of the cross product
+			if ((long long)dir.x * alt.y - (long long)dir.y * alt.x > 0)
+				++next;
+		}
+		return next;
+	};
+
+	// Lambda-function for adding the vertex to the contour, skipping the collinear ones
+	auto lAddVertex = [](vector<Point> & contour, const Point & p) {
+		size_t n = contour.size();
+		if (n >= 2) {
+			Point d1 = contour[n-1] - contour[n-2];
+			Point d2 = p - contour[n-1];
+			if ((long long)d1.x * d2.y - (long long)d1.y * d2.x == 0) {
+				contour[n-1] = p;
+				return;
+			}
+		}
+		contour.push_back(p);
+	};
+
+	// Trace closed contours
+	vector<vector<Point>> contours;
+	vector<bool> used(edges.size(), false);
+	size_t outerIdx = 0;
+	long long outerArea = 0;
+	for (size_t first = 0; first < edges.size(); first++) {
+		if (used[first]) continue;
+		vector<Point> contour;
+		size_t cur = first;
+		do {
+			used[cur] = true;
+			lAddVertex(contour, edges[cur].from);
+			cur = lNextEdge(cur);
+		} while (cur != first);
+		// Remove collinear vertex at the contour start, if any
+		lAddVertex(contour, contour.front());
+		contour.pop_back();
+		if (contour.size() >= 3) {
+			Point d1 = contour[0] - contour.back();
+			Point d2 = contour[1] - contour[0];
+			if ((long long)d1.x * d2.y - (long long)d1.y * d2.x == 0)
+				contour.erase(contour.begin());
+		}
+		// Outer contour is the one with positive (clockwise on the screen) area
+		long long area = 0;
+		for (size_t i = 0; i < contour.size(); i++) {
+			const Point & a = contour[i];
+			const Point & b = contour[(i+1) % contour.size()];
+			area += (long long)a.x * b.y - (long long)b.x * a.y;
+		}
+		if (area > outerArea) {
+			outerArea = area;
+			outerIdx = contours.size();
+		}
+		contours.push_back(contour);
+	}
+	if (!contours.empty())
+		swap(contours[0], contours[outerIdx]);
+	return contours;
+}
+
+
+//! Paints the region on the mask image with the given value
+/*!
+  \param mask - CV_8UC1 image of the same size as processed image
+  \param value - value of the region pixels on the mask
+*/
+void Region::drawOnMask(cv::Mat & mask, uchar value) const {
+	for (const std::vector<RegionSpan> & row : rowSpans)
+		for (const RegionSpan & span : row)
+			mask.row(span.row).colRange(span.colBeg, span.colEnd).setTo(value);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/*! \headerfile Region.h "/src/Region.h"
+    \brief Header of class Region
+
+    Class stores the contiguous region as sorted row run-length spans and builds its contour polygons.
+*/
+
+//! One horizontal run of region pixels, columns [colBeg; colEnd) of the row 'row'
+struct RegionSpan {
+	int row;
+	int colBeg;
+	int colEnd;
+};
+
+
+class Region {
+
+	private:
+		//! Private variable, contains sorted and non-overlapping spans for each image row
+		std::vector<std::vector<RegionSpan>> rowSpans;
+		//! Private variable, contains the total number of spans
+		size_t spansN = 0;
+		//! Private variable, contains the total number of pixels in region
+		size_t pixelsN = 0;
+
+	public:
+		//! Default constructor
+		Region() = default;
+
+		//! Reset the region to empty state for the image with given number of rows
+		void reset(int);
+
+		//! Add span [colBeg; colEnd) to the row; merges it with adjacent spans
+		void addSpan(int, int, int);
+
+		//! Returns the end of the span covering the pixel, or -1 if the pixel is not in region
+		int spanEndAt(int, int) const;
+
+		//! Check whether the pixel belongs to the region
+		bool contains(int, int) const;
+
+		//! Getter for the number of spans
+		size_t getSpansN() const;
+
+		//! Getter for the number of pixels
+		size_t getPixelsN() const;
+
+		//! Returns all spans sorted by row and then by column
+		std::vector<RegionSpan> getSpans() const;
+
+		//! Returns the contours of the region: outer one first, then the inner ones (holes)
+		std::vector<std::vector<cv::Point>> getContours() const;
+
+		//! Paints the region on the mask image with the given value
+		void drawOnMask(cv::Mat &, uchar) const;
+
+};
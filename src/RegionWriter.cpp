@@ -0,0 +1,120 @@
+/*! \file RegionWriter.cpp
+	\class RegionWriter RegionWriter.cpp "/src/RegionWriter.cpp"
+    \brief Class streams found regions to the binary file, one record per region.
+
+    Class streams found regions to the binary file, one record per region.
+	The size of the record depends on the region complexity only, not on the image size.
+*/
+
+#include <iostream>
+#include <cstring>
+#include "../src/RegionWriter.h"
+
+
+constexpr uint32_t RegionWriter::FORMAT_VERSION;
+
+
+//! Write unsigned 32-bit value in little-endian order
+void RegionWriter::writeU32(uint32_t val) {
+	char bytes[4];
+	for (int i = 0; i < 4; i++)
+		bytes[i] = (char)((val >> (8*i)) & 0xFF);
+	out.write(bytes, 4);
+}
+
+
+//! Write signed 32-bit value in little-endian order
+void RegionWriter::writeI32(int32_t val) {
+	writeU32((uint32_t)val);
+}
+
+
+//! Write double value in little-endian order
+void RegionWriter::writeF64(double val) {
+	uint64_t bits;
+	std::memcpy(&bits, &val, sizeof(bits));
+	writeU32((uint32_t)(bits & 0xFFFFFFFF));
+	writeU32((uint32_t)(bits >> 32));
+}
+
+
+//! Open the output file and write the file header
+/*!
+  \param fName - name of the output file; existing file is overwritten
+  \return 0 if the file was opened successfully
+*/
+bool RegionWriter::open(const std::string & fName) {
+	out.open(fName, std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) {
+		std::cout << "Couldn't open the output file \"" << fName << "\"" << std::endl;
+		return -1;
+	}
+	out.write("FCRG", 4);
+	writeU32(FORMAT_VERSION);
+	return 0;
+}
+
+
+//! Check whether the output file is opened
+bool RegionWriter::isOpen() const {
+	return out.is_open();
+}
+
+
+//! Write one region record
+/*!
+  \param region - found region
+  \param seed - pixel selected by user
+  \param imgSize - size of the processed image
+  \param clDistType - type of the applied color distance
+  \param clDistThr - threshold value of the applied color distance
+  \param parts - parts of the region to be written, combination of RegionWriter::Parts
+  \return 0 if the record was written successfully
+*/
+bool RegionWriter::write(const Region & region, const cv::Point & seed, const cv::Size & imgSize,
+						 uint8_t clDistType, double clDistThr, uint32_t parts) {
+	if (!out.is_open())
+		return -1;
+
+	writeI32(imgSize.width);
+	writeI32(imgSize.height);
+	writeI32(seed.x);
+	writeI32(seed.y);
+	writeU32(clDistType);
+	writeF64(clDistThr);
+	writeU32(parts);
+
+	if (parts & SPANS) {
+		writeU32((uint32_t)region.getSpansN());
+		for (const RegionSpan & span : region.getSpans()) {
+			writeI32(span.row);
+			writeI32(span.colBeg);
+			writeI32(span.colEnd);
+		}
+	}
+	if (parts & CONTOURS) {
+		std::vector<std::vector<cv::Point>> contours = region.getContours();
+		writeU32((uint32_t)contours.size());
+		for (const std::vector<cv::Point> & contour : contours) {
+			writeU32((uint32_t)contour.size());
+			for (const cv::Point & pt : contour) {
+				writeI32(pt.x);
+				writeI32(pt.y);
+			}
+		}
+	}
+	// Flush the record, so the reader following the file never sees the partial one
+	out.flush();
+	if (!out.good()) {
+		std::cout << "Couldn't write the region to the output file" << std::endl;
+		return -1;
+	}
+	return 0;
+}
+
+
+//! Flush and close the output file
+void RegionWriter::close() {
+	if (out.is_open())
+		out.close();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <opencv2/core/core.hpp>
+#include "../src/Region.h"
+
+/*! \headerfile RegionWriter.h "/src/RegionWriter.h"
+    \brief Header of class RegionWriter
+
+    Class streams found regions to the binary file, one record per region.\n
+	All the values are little-endian. File starts with magic "FCRG" and uint32 format version,
+	then records follow:\n
+		int32 image cols, int32 image rows, int32 seed X, int32 seed Y,\n
+		uint32 color distance type, float64 color distance threshold, uint32 flags (see RegionWriter::Parts),\n
+		if spans are written: uint32 number of spans, then int32 row, colBeg, colEnd for each span;\n
+		if contours are written: uint32 number of contours (outer one is the first), then for each contour
+		uint32 number of vertices and int32 X, Y for each vertex.\n
+	Flag TRUNCATED marks the region stopped by the fill budget. When the truncated fill is resumed,
+	one more record for the same seed is appended; the last record for the seed supersedes the previous ones.\n
+	Each record is flushed to the file as soon as it is written.
+*/
+class RegionWriter {
+
+	private:
+		//! Private variable, contains output file stream
+		std::ofstream out;
+
+		//! Write unsigned 32-bit value in little-endian order
+		void writeU32(uint32_t);
+		//! Write signed 32-bit value in little-endian order
+		void writeI32(int32_t);
+		//! Write double value in little-endian order
+		void writeF64(double);
+
+	public:
+		//! Parts of the region to be written and flags of the record, may be combined
+		enum Parts : uint32_t {
+			SPANS = 1,
+			CONTOURS = 2,
+			//! Region was truncated by the fill budget
+			TRUNCATED = 4
+		};
+
+		//! Version of the file format
+		static constexpr uint32_t FORMAT_VERSION = 1;
+
+		//! Default constructor
+		RegionWriter() = default;
+
+		//! Open the output file and write the file header
+		bool open(const std::string &);
+
+		//! Check whether the output file is opened
+		bool isOpen() const;
+
+		//! Write one region record
+		bool write(const Region &, const cv::Point &, const cv::Size &, uint8_t, double, uint32_t);
+
+		//! Flush and close the output file
+		void close();
+
+};
@@ -19,12 +19,33 @@ Visualizer::Visualizer(const std::string & _fName):
 {};
 
 
+//! Setter for the directory of preprocessed images cache
+/*!
+	\param cacheDir - path to the cache directory; empty string disables the cache
+*/
+void Visualizer::setCacheDir(const std::string & cacheDir) {
+	imgCache.setCacheDir(cacheDir);
+}
+
+
 //! Methods reads test (base) image using its filename and shows it in window
 bool Visualizer::readBaseImg() {
 	using namespace std;
 	using namespace cv;
 	
-	baseImg = imread("../input/" + fName, IMREAD_COLOR);
+	string srcFName = "../input/" + fName;
+	// Try to map the preprocessed image from the cache first
+	if (imgCache.isEnabled() && !imgCache.load(srcFName, baseImg, labImg, chromaImg)) {
+		imgMapped = true;
+		cout << endl << " Image is loaded from the cache";
+	}
+	else {
+		baseImg = imread(srcFName, IMREAD_COLOR);
+		// Cache the decoded image only; Lab planes are added by updateCache() when they are needed,
+		// so this start keeps the lazy conversion of Lab tiles
+		if (imgCache.isEnabled() && !baseImg.empty())
+			imgCache.store(srcFName, baseImg, Mat(), Mat());
+	}
 	
 	cout << endl << " Image: \"" << fName <<
 					"\",\n Image size = " << baseImg.size() <<
@@ -70,6 +91,60 @@ bool Visualizer::showMaskImg() {
 }
 
 
+//! Open the binary file for streaming the found regions
+/*!
+	\param outFName - name of the output file
+*/
+bool Visualizer::setOutputFile(const std::string & outFName) {
+	return regWriter.open(outFName);
+}
+
+
+//! Setter for the budget of the fill
+/*!
+	\param budget - limits of the fill, see FillBudget
+*/
+void Visualizer::setFillBudget(const FillBudget & budget) {
+	this->budget = budget;
+	resumeBudget = budget;
+	convObj.setBudget(budget);
+}
+
+
+//! Adds Lab planes used by the chosen color distance to the cache, if they aren't there yet
+/*!
+	Should be called at the end of processing: the tiles already converted by the fill are reused,
+	only the rest of the image is converted.
+*/
+void Visualizer::updateCache() {
+	using namespace cv;
+	
+	bool needLab = (clDistType == 3 || clDistType == 4);
+	bool needChroma = (clDistType == 4);
+	if (!imgCache.isEnabled() || baseImg.empty() || !needLab)
+		return;
+	if (!labImg.empty() && (!needChroma || !chromaImg.empty()))
+		return;
+	Mat lab = labImg;
+	Mat chroma = chromaImg;
+	if (lab.empty())
+		convObj.getLabImg(lab);
+	if (needChroma && chroma.empty())
+		Converter::calcChromaImg(lab, chroma);
+	// Replacing the entry unmaps it on Windows, so the images mapped from it are copied first
+	if (imgMapped) {
+		baseImg = baseImg.clone();
+		labImg = lab = lab.clone();
+		chromaImg = chroma = chroma.clone();
+		convObj.setBaseImg(baseImg);
+		convObj.setLabImg(labImg, chromaImg);
+		convObj.setParams(clDistType, clDistThr);
+		imgMapped = false;
+	}
+	imgCache.store("../input/" + fName, baseImg, lab, chroma);
+}
+
+
 //! Main function of the utility
 /*!
 	\param clDistType - type of the color distance to be applied
@@ -77,8 +152,14 @@ bool Visualizer::showMaskImg() {
 */
 bool Visualizer::startProcessing(uint8_t clDistType, double clDistThr) {
 	using namespace cv;
+	// Remember parameters for the output file
+	this->clDistType = clDistType;
+	this->clDistThr = clDistThr;
 	// Send test (base) image to the object
 	convObj.setBaseImg(baseImg);
+	// Send preprocessed Lab image, if any, so the object doesn't convert the base image itself
+	if (!labImg.empty())
+		convObj.setLabImg(labImg, chromaImg);
 	// Send necessary parameters to the object
 	convObj.setParams(clDistType, clDistThr);
 	// Set mouse callback for choosing the pixel by mouse pointer in the window with test (base) image
@@ -119,15 +200,67 @@ void Visualizer::mCallback(int x, int y){
 	if (DefParams::DEBUG) cout << "Captured position: [x = " << x << ", y = " << y << "]" << endl;
 	// Set up chosen pixel coordinates on the test (base image)
 	convObj.setPoint(Point(x, y));
-	// Reset binary mask for removing any previous results
-	convObj.resetMaskImg();
+	pxPos = Point(x, y);
+	// Reset binary mask for removing any previous results; span fill draws its own one
+	if (!regWriter.isOpen())
+		convObj.resetMaskImg();
+	// New fill starts with the configured budget, even if the previous one was resumed with the raised budget
+	resumeBudget = budget;
+	convObj.setBudget(budget);
+	// Run main algorithm
+	runFill(false);
+}
+
+
+//! Continue the fill truncated by the budget for the last selected pixel
+void Visualizer::resumeProcessing() {
+	using namespace std;
+	
+	FillStatus status = regWriter.isOpen() ? convObj.getSpanFillStatus() : convObj.getFillStatus();
+	if (pxPos.x < 0 || status == FILL_COMPLETE) {
+		cout << " Nothing to resume" << endl;
+		return;
+	}
+	// Pixels, distance and ROI limits apply to the whole region, so they are raised for resuming;
+	// time limit applies to each call and stays as it is
+	resumeBudget.maxPixels *= 2;
+	resumeBudget.maxDist *= 2;
+	resumeBudget.roi = cv::Rect();
+	convObj.setBudget(resumeBudget);
+	runFill(true);
+}
+
+
+//! Runs the fill (or resumes it), reports the time and shows the results
+/*!
+	\param resume - whether to continue the truncated fill or to start the new one
+*/
+void Visualizer::runFill(bool resume) {
+	using namespace std;
+	using namespace cv;
+	
 	// Fix the time before running the algorithm
 	double testTime = (double)getTickCount();
-	// Run main algorithm
-	convObj.findRegion();
+	// Run main algorithm; if the output file is set, the region is found as spans only
+	FillStatus status;
+	if (regWriter.isOpen())
+		status = resume ? convObj.resumeRegionSpans() : convObj.findRegionSpans();
+	else
+		status = resume ? convObj.resumeRegion() : convObj.findRegion();
 	// Fix the time when algorithms finishes
 	testTime = ((double)getTickCount() - testTime)/getTickFrequency() * 1000;
 	cout << " Test time in milliseconds: " << setprecision(4) << testTime << " msec." << endl;
+	if (status == FILL_TRUNCATED)
+		cout << " Region is truncated by the budget, press 'r' to continue" << endl;
+	
+	// Stream the spans to the output file and draw them on the mask for showing
+	if (regWriter.isOpen()) {
+		uint32_t parts = RegionWriter::SPANS | RegionWriter::CONTOURS;
+		if (status == FILL_TRUNCATED)
+			parts |= RegionWriter::TRUNCATED;
+		regWriter.write(convObj.getRegion(), pxPos, baseImg.size(), clDistType, clDistThr, parts);
+		convObj.drawRegionMask();
+	}
 	
 	// Show the obtained binary mask on separate window
 	convObj.showMaskImg();	
@@ -11,6 +11,8 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/opencv.hpp>
 #include "../src/Converter.h"
+#include "../src/RegionWriter.h"
+#include "../src/ImageCache.h"
 
 
 class Visualizer {
@@ -18,10 +20,33 @@ class Visualizer {
 	private:
 		//! Private variable, contains input test image filename
 		std::string fName;
+		//! Private variable, contains cache of preprocessed images; declared before images which may refer to its memory
+		ImageCache imgCache;
 		//! Private variable, contains input test image
 		cv::Mat baseImg;
+		//! Private variable, contains input test image in Lab color space, if it is prepared by cache
+		cv::Mat labImg;
+		//! Private variable, contains chroma plane of 'labImg', if it is prepared by cache
+		cv::Mat chromaImg;
+		//! Private variable, whether the images refer to the mapped cache entry
+		bool imgMapped = false;
 		//! Private variable, contains Converter object
 		Converter convObj;
+		//! Private variable, contains writer of the found regions to the output file
+		RegionWriter regWriter;
+		//! Private variable, contains type of the color distance to be applied
+		uint8_t clDistType = DefParams::DEFAULT_CLDIST_TYPE;
+		//! Private variable, contains threshold value for the color distance to be applied
+		double clDistThr = DefParams::DEFAULT_CLDIST_THRD;
+		//! Private variable, contains limits of the fill set by user; each new fill starts with them
+		FillBudget budget;
+		//! Private variable, contains limits of the resumed fill; raised each time the truncated fill is resumed
+		FillBudget resumeBudget;
+		//! Private variable, contains position of the last selected pixel
+		cv::Point pxPos = cv::Point(-1, -1);
+		
+		//! Runs the fill (or resumes it), reports the time and shows the results
+		void runFill(bool);
 	
 	public:		
 		//! Constructor of the class
@@ -30,6 +55,12 @@ class Visualizer {
 		*/
 		Visualizer(const std::string & _fName);
 		
+		//! Setter for the directory of preprocessed images cache
+		/*!
+			\param cacheDir - path to the cache directory; empty string disables the cache
+		*/
+		void setCacheDir(const std::string &);
+		
 		//! Methods reads test (base) image using its filename and shows it in window
 		bool readBaseImg();
 		
@@ -45,6 +76,24 @@ class Visualizer {
 		//! Visualize the mask (binary, output) image in a window
 		bool showMaskImg();
 		
+		//! Open the binary file for streaming the found regions
+		/*!
+			\param outFName - name of the output file
+		*/
+		bool setOutputFile(const std::string &);
+		
+		//! Setter for the budget of the fill
+		/*!
+			\param budget - limits of the fill, see FillBudget
+		*/
+		void setFillBudget(const FillBudget &);
+		
+		//! Continue the fill truncated by the budget for the last selected pixel
+		void resumeProcessing();
+		
+		//! Adds Lab planes used by the chosen color distance to the cache, if they aren't there yet
+		void updateCache();
+		
 		//! Main function of the utility
 		/*!
 			\param clDistType - type of the color distance to be applied
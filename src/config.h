@@ -31,6 +31,20 @@ namespace DefParams {
 		Note that THRD values are squared comparing to the formulas in Wiki, for calculation simplicity.
 	*/
 	constexpr double DEFAULT_CLDIST_THRD = 120;
+	/*! \param LAB_TILE_SHIFT Log2 of the tile size for lazy conversion of the image to Lab color space */
+	constexpr int LAB_TILE_SHIFT = 6;
+	/*! \param LAB_TILE_SIZE Size of the tile for lazy conversion of the image to Lab color space, 64x64 pixels */
+	constexpr int LAB_TILE_SIZE = 1 << LAB_TILE_SHIFT;
+	/*! \param DEFAULT_MAX_PIXELS Default maximum number of pixels in region, 0 - no limit */
+	constexpr size_t DEFAULT_MAX_PIXELS = 0;
+	/*! \param DEFAULT_MAX_DIST Default maximum distance of region pixels from the selected one, 0 - no limit */
+	constexpr int DEFAULT_MAX_DIST = 0;
+	/*! \param DEFAULT_MAX_TIME_MS Default time limit of the fill in milliseconds, 0 - no limit */
+	constexpr double DEFAULT_MAX_TIME_MS = 0;
+	/*! \param DEADLINE_CHECK_PERIOD Number of checked pixels between the clock readings */
+	constexpr size_t DEADLINE_CHECK_PERIOD = 256;
+	/*! \param DEFAULT_CACHE_DIR Default directory of preprocessed images cache, empty string - cache is disabled */
+	constexpr const char* DEFAULT_CACHE_DIR = "";
 	
 	/*! \param k_L Parameter value for type 4 distance, CIE94 */
 	constexpr int k_L = 1/1;
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <iostream>
+
+/*! \file testCommon.h
+    \brief Checks shared by the test executables.
+
+    CHECK() counts the failed conditions and prints them; finishTests() prints the summary
+	and returns the exit code of the test executable.
+*/
+
+
+//! Number of failed checks
+static int failsN = 0;
+
+#define CHECK(cond, msg) \
+	do { if (!(cond)) { failsN++; std::cout << " FAILED: " << msg << " (line " << __LINE__ << ")" << std::endl; } } while (0)
+
+
+//! Print the summary of the checks and return the exit code
+static int finishTests() {
+	if (failsN)
+		std::cout << failsN << " checks failed" << std::endl;
+	else
+		std::cout << "All checks passed" << std::endl;
+	return failsN ? 1 : 0;
+}
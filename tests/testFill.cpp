@@ -0,0 +1,272 @@
+/*! \file testFill.cpp
+    \brief Tests of the mask fill and the span fill on synthetic images.
+
+    Both fills should find the same region with and without the budget, report the truncation
+	correctly and reach the whole region after resuming. Contours and lazy Lab conversion are checked as well.
+*/
+
+#include <random>
+#include "../src/Converter.h"
+#include "testCommon.h"
+
+
+//! Number of region pixels on the mask
+static size_t countMask(const cv::Mat & mask) {
+	size_t n = 0;
+	for (int row = 0; row < mask.rows; row++)
+		for (int col = 0; col < mask.cols; col++)
+			n += (mask.at<uchar>(row, col) == 255);
+	return n;
+}
+
+
+//! Check whether the mask fill and the span fill found the same pixels
+static bool sameRegion(const cv::Mat & mask, const Region & region) {
+	for (int row = 0; row < mask.rows; row++)
+		for (int col = 0; col < mask.cols; col++)
+			if ((mask.at<uchar>(row, col) == 255) != region.contains(row, col))
+				return false;
+	return countMask(mask) == region.getPixelsN();
+}
+
+
+//! Check whether two regions consist of the same spans
+static bool sameSpans(const Region & a, const Region & b) {
+	std::vector<RegionSpan> spansA = a.getSpans();
+	std::vector<RegionSpan> spansB = b.getSpans();
+	if (spansA.size() != spansB.size())
+		return false;
+	for (size_t idx = 0; idx < spansA.size(); idx++)
+		if (spansA[idx].row != spansB[idx].row || spansA[idx].colBeg != spansB[idx].colBeg ||
+			spansA[idx].colEnd != spansB[idx].colEnd)
+			return false;
+	return true;
+}
+
+
+//! Check whether all the pixels of the region are in the reference mask
+static bool isSubRegion(const Region & region, const cv::Mat & refMask) {
+	for (const RegionSpan & span : region.getSpans())
+		for (int col = span.colBeg; col < span.colEnd; col++)
+			if (refMask.at<uchar>(span.row, col) != 255)
+				return false;
+	return true;
+}
+
+
+//! Random image of several flat colors, so the regions have holes and diagonal contacts
+static cv::Mat makeImage(std::mt19937 & rng, int rows, int cols) {
+	cv::Mat img = cv::Mat::zeros(rows, cols, CV_8UC3);
+	for (int row = 0; row < rows; row++)
+		for (int col = 0; col < cols; col++)
+			img.at<cv::Vec3b>(row, col)[0] = (rng() % 4 == 0) ? 100 : 0;
+	return img;
+}
+
+
+//! Distance 3 with maximum distance from the seed: only the seed row was found by the span fill before
+static void testDistanceCircle() {
+	cv::Mat img = cv::Mat::zeros(21, 21, CV_8UC3);
+	Converter conv;
+	conv.setBaseImg(img);
+	conv.setParams(0, 10);
+	FillBudget budget;
+	budget.maxDist = 3;
+	conv.setBudget(budget);
+	conv.setPoint(cv::Point(10, 10));
+	conv.resetMaskImg();
+	CHECK(conv.findRegion() == FILL_TRUNCATED, "circle: mask fill status");
+	CHECK(conv.findRegionSpans() == FILL_TRUNCATED, "circle: span fill status");
+	CHECK(countMask(conv.getMaskImg()) == 29, "circle: mask fill pixels");
+	CHECK(conv.getRegion().getPixelsN() == 29, "circle: span fill pixels");
+	CHECK(sameRegion(conv.getMaskImg(), conv.getRegion()), "circle: fills differ");
+}
+
+
+//! Wide image with the tiny time budget: the clock is read within the span, not once per seed
+static void testTimeWide() {
+	cv::Mat img = cv::Mat::zeros(3, 20000, CV_8UC3);
+	Converter conv;
+	conv.setBaseImg(img);
+	conv.setParams(0, 10);
+	FillBudget budget;
+	budget.maxTimeMs = 1e-9;
+	conv.setBudget(budget);
+	conv.setPoint(cv::Point(10000, 1));
+	FillStatus status = conv.findRegionSpans();
+	CHECK(status == FILL_TRUNCATED, "wide: span fill isn't truncated");
+	CHECK(conv.getRegion().getPixelsN() <= 2 * DefParams::DEADLINE_CHECK_PERIOD, "wide: span fill didn't stop in time");
+	for (int resumesN = 0; resumesN < 100000 && status == FILL_TRUNCATED; resumesN++)
+		status = conv.resumeRegionSpans();
+	CHECK(status == FILL_COMPLETE, "wide: resume didn't complete");
+	CHECK(conv.getRegion().getPixelsN() == (size_t)img.total(), "wide: resumed span fill differs");
+}
+
+
+//! Fills with each kind of the budget, then resuming with no budget
+static void testBudgets() {
+	std::mt19937 rng(1);
+	for (int iter = 0; iter < 500; iter++) {
+		int rows = 1 + rng() % 80;
+		int cols = 1 + rng() % 80;
+		cv::Mat img = makeImage(rng, rows, cols);
+		cv::Point seed(rng() % cols, rng() % rows);
+
+		// Reference region without the budget
+		Converter ref;
+		ref.setBaseImg(img);
+		ref.setParams(0, 10);
+		ref.setPoint(seed);
+		ref.resetMaskImg();
+		CHECK(ref.findRegion() == FILL_COMPLETE, "no budget: mask fill status");
+		CHECK(ref.findRegionSpans() == FILL_COMPLETE, "no budget: span fill status");
+		CHECK(sameRegion(ref.getMaskImg(), ref.getRegion()), "no budget: fills differ");
+		cv::Mat refMask = ref.getMaskImg();
+		size_t refN = ref.getRegion().getPixelsN();
+		ref.drawRegionMask();
+		CHECK(sameRegion(ref.getMaskImg(), ref.getRegion()), "no budget: drawn mask differs");
+
+		int kind = iter % 4;
+		FillBudget budget;
+		if (kind == 0)
+			budget.maxPixels = 1 + rng() % 100;
+		else if (kind == 1)
+			budget.roi = cv::Rect(rng() % cols, rng() % rows, 1 + rng() % cols, 1 + rng() % rows);
+		else if (kind == 2)
+			budget.maxDist = 1 + rng() % 15;
+		else
+			budget.maxTimeMs = 1e-9;
+
+		Converter conv;
+		conv.setBaseImg(img);
+		conv.setParams(0, 10);
+		conv.setBudget(budget);
+		conv.setPoint(seed);
+		conv.resetMaskImg();
+		FillStatus maskStatus = conv.findRegion();
+		FillStatus spanStatus = conv.findRegionSpans();
+		size_t maskN = countMask(conv.getMaskImg());
+		size_t spanN = conv.getRegion().getPixelsN();
+		CHECK(maskN <= refN && isSubRegion(conv.getRegion(), refMask), "budget " << kind << ": region is not a part of the whole one");
+		if (kind == 0) {
+			CHECK(maskN <= budget.maxPixels && spanN <= budget.maxPixels, "pixels budget exceeded");
+			CHECK(maskN == std::min(refN, budget.maxPixels) && spanN == maskN, "pixels budget: region isn't filled up to the budget");
+		}
+		if (kind == 1 || kind == 2)
+			CHECK(sameRegion(conv.getMaskImg(), conv.getRegion()), "budget " << kind << ": fills differ");
+		// Truncation is exact for all the limits except time, which may stop the fill right before its end
+		if (kind != 3) {
+			CHECK((maskStatus == FILL_COMPLETE) == (maskN == refN), "budget " << kind << ": mask fill status");
+			CHECK((spanStatus == FILL_COMPLETE) == (spanN == refN), "budget " << kind << ": span fill status");
+		}
+		else {
+			CHECK(maskStatus == FILL_TRUNCATED || maskN == refN, "time budget: mask fill status");
+			CHECK(spanStatus == FILL_TRUNCATED || spanN == refN, "time budget: span fill status");
+		}
+
+		// Resume: time budget stays, the others are lifted
+		if (kind != 3)
+			conv.setBudget(FillBudget());
+		for (int resumesN = 0; resumesN < 100000 && maskStatus == FILL_TRUNCATED; resumesN++)
+			maskStatus = conv.resumeRegion();
+		for (int resumesN = 0; resumesN < 100000 && spanStatus == FILL_TRUNCATED; resumesN++)
+			spanStatus = conv.resumeRegionSpans();
+		CHECK(maskStatus == FILL_COMPLETE && spanStatus == FILL_COMPLETE, "budget " << kind << ": resume didn't complete");
+		CHECK(countMask(conv.getMaskImg()) == refN, "budget " << kind << ": resumed mask fill differs");
+		CHECK(isSubRegion(conv.getRegion(), refMask) && conv.getRegion().getPixelsN() == refN,
+			  "budget " << kind << ": resumed span fill differs");
+	}
+}
+
+
+//! Contours area should be equal to the region area, the outer one goes first
+static void testContours() {
+	std::mt19937 rng(2);
+	for (int iter = 0; iter < 500; iter++) {
+		int rows = 1 + rng() % 40;
+		int cols = 1 + rng() % 40;
+		cv::Mat img = makeImage(rng, rows, cols);
+		Converter conv;
+		conv.setBaseImg(img);
+		conv.setParams(0, 10);
+		conv.setPoint(cv::Point(rng() % cols, rng() % rows));
+		conv.findRegionSpans();
+		std::vector<std::vector<cv::Point>> contours = conv.getRegion().getContours();
+		CHECK(!contours.empty(), "contours: no outer contour");
+		long long areaSum = 0;
+		for (size_t idx = 0; idx < contours.size(); idx++) {
+			const std::vector<cv::Point> & contour = contours[idx];
+			long long area = 0;
+			for (size_t k = 0; k < contour.size(); k++) {
+				const cv::Point & a = contour[k];
+				const cv::Point & b = contour[(k+1) % contour.size()];
+				CHECK(a.x == b.x || a.y == b.y, "contours: edge isn't axis-aligned");
+				area += (long long)a.x * b.y - (long long)b.x * a.y;
+			}
+			CHECK((idx == 0) ? area > 0 : area < 0, "contours: wrong orientation of contour " << idx);
+			areaSum += area;
+		}
+		CHECK(areaSum == 2 * (long long)conv.getRegion().getPixelsN(), "contours: area differs from region");
+	}
+}
+
+
+//! Lazy conversion of Lab tiles should give the same region as the whole converted image
+static void testLazyLab() {
+	std::mt19937 rng(3);
+	for (int iter = 0; iter < 50; iter++) {
+		int rows = 1 + rng() % 200;
+		int cols = 1 + rng() % 200;
+		cv::Mat img = cv::Mat::zeros(rows, cols, CV_8UC3);
+		for (int row = 0; row < rows; row++)
+			for (int col = 0; col < cols; col++)
+				for (int ch = 0; ch < 3; ch++)
+					img.at<cv::Vec3b>(row, col)[ch] = (uchar)((rng() % 3) * 4 + (col / 50) * 60);
+		uint8_t distType = 3 + iter % 2;
+		double distThr = (distType == 3) ? 300 : 60;
+		cv::Point seed(rng() % cols, rng() % rows);
+
+		Converter lazy;
+		lazy.setBaseImg(img);
+		lazy.setParams(distType, distThr);
+		lazy.setPoint(seed);
+		lazy.resetMaskImg();
+		lazy.findRegion();
+
+		Converter eager;
+		cv::Mat lab, chroma;
+		cv::cvtColor(img, lab, cv::COLOR_BGR2Lab);
+		Converter::calcChromaImg(lab, chroma);
+		eager.setBaseImg(img);
+		eager.setLabImg(lab, chroma);
+		eager.setParams(distType, distThr);
+		eager.setPoint(seed);
+		eager.findRegionSpans();
+		CHECK(sameRegion(lazy.getMaskImg(), eager.getRegion()), "lazy Lab: regions differ for distance " << (int)distType);
+
+		// Switching to BGR distance and back keeps the converted tiles and uses the right image
+		Converter bgr;
+		bgr.setBaseImg(img);
+		bgr.setParams(0, 10);
+		bgr.setPoint(seed);
+		bgr.findRegionSpans();
+		lazy.setParams(0, 10);
+		lazy.setPoint(seed);
+		lazy.findRegionSpans();
+		CHECK(sameSpans(lazy.getRegion(), bgr.getRegion()), "lazy Lab: BGR region differs after Lab one");
+		lazy.setParams(distType, distThr);
+		lazy.setPoint(seed);
+		lazy.findRegionSpans();
+		CHECK(sameSpans(lazy.getRegion(), eager.getRegion()), "lazy Lab: region differs after switching back");
+	}
+}
+
+
+int main() {
+	testDistanceCircle();
+	testBudgets();
+	testTimeWide();
+	testContours();
+	testLazyLab();
+	return finishTests();
+}
@@ -0,0 +1,73 @@
+/*! \file testImageCache.cpp
+    \brief Tests of the preprocessed images cache.
+
+    Stored planes should be mapped back unchanged; the entry should survive 'touch' of the source
+	and become stale after the change of the source content.
+*/
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include "../src/ImageCache.h"
+#include "../src/Converter.h"
+#include "testCommon.h"
+
+
+//! Write the content to the file
+static void writeFile(const std::string & fName, const std::string & content) {
+	std::ofstream out(fName, std::ios::binary | std::ios::trunc);
+	out << content;
+}
+
+
+//! Check whether two images have the same pixels
+static bool sameImg(const cv::Mat & a, const cv::Mat & b) {
+	if (a.size() != b.size() || a.type() != b.type())
+		return false;
+	for (int row = 0; row < a.rows; row++)
+		if (std::memcmp(a.ptr(row), b.ptr(row), a.cols * a.elemSize()) != 0)
+			return false;
+	return true;
+}
+
+
+int main() {
+	const std::string srcFName = "testImageCache_src.bin";
+	writeFile(srcFName, "source image");
+
+	cv::Mat bgr = cv::Mat::zeros(7, 5, CV_8UC3);
+	for (int row = 0; row < bgr.rows; row++)
+		for (int col = 0; col < bgr.cols; col++)
+			bgr.at<cv::Vec3b>(row, col) = cv::Vec3b((uchar)row, (uchar)col, (uchar)(row*col));
+	cv::Mat lab, chroma;
+	cv::cvtColor(bgr, lab, cv::COLOR_BGR2Lab);
+	Converter::calcChromaImg(lab, chroma);
+
+	ImageCache cache("testImageCache_dir");
+	cv::Mat bgr2, lab2, chroma2;
+
+	// BGR-only entry
+	CHECK(cache.store(srcFName, bgr, cv::Mat(), cv::Mat()) == 0, "BGR entry isn't stored");
+	CHECK(cache.load(srcFName, bgr2, lab2, chroma2) == 0, "BGR entry isn't loaded");
+	CHECK(sameImg(bgr, bgr2) && lab2.empty() && chroma2.empty(), "BGR entry differs");
+
+	// Entry with all the planes
+	CHECK(cache.store(srcFName, bgr, lab, chroma) == 0, "full entry isn't stored");
+	CHECK(cache.load(srcFName, bgr2, lab2, chroma2) == 0, "full entry isn't loaded");
+	CHECK(sameImg(bgr, bgr2) && sameImg(lab, lab2) && sameImg(chroma, chroma2), "full entry differs");
+
+	// Same content with the new time is still valid
+	writeFile(srcFName, "source image");
+	CHECK(cache.load(srcFName, bgr2, lab2, chroma2) == 0, "entry is stale after rewriting the same content");
+	CHECK(sameImg(bgr, bgr2), "entry differs after rewriting the same content");
+
+	// Changed content of the same size is stale
+	writeFile(srcFName, "SOURCE IMAGE");
+	CHECK(cache.load(srcFName, bgr2, lab2, chroma2) != 0, "entry isn't stale after changing the content");
+
+	// Missing source
+	std::remove(srcFName.c_str());
+	CHECK(cache.load(srcFName, bgr2, lab2, chroma2) != 0, "entry is loaded for missing source");
+
+	return finishTests();
+}